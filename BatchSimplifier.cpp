@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <thread>
+#include "BatchSimplifier.h"
+
+/**
+ * Constructor with the functions to simplify, using one thread per hardware thread
+ *
+ * @param functions The minterms and "dont care's" of each function
+ */
+BatchSimplifier::BatchSimplifier(vector<std::pair<vector<int>, vector<int>>> functions)
+    : BatchSimplifier(functions, 0) {}
+
+/**
+ * Constructor with the functions to simplify and the number of threads to use
+ *
+ * @param functions The minterms and "dont care's" of each function
+ * @param numThreads The number of threads to use, or 0 for one per hardware thread
+ */
+BatchSimplifier::BatchSimplifier(vector<std::pair<vector<int>, vector<int>>> functions, int numThreads)
+    : functions_{functions}, numThreads_(numThreads) {
+  if (numThreads_ <= 0) numThreads_ = std::max(1, (int) std::thread::hardware_concurrency());
+}
+
+/**
+ * Simplifies every function
+ *
+ * @return The essential primes of each function, in the same order as the functions were given
+ */
+vector<std::set<Implicant>> BatchSimplifier::simplify() {
+  essentialPrimes_.assign(functions_.size(), {});
+  equations_.assign(functions_.size(), "");
+
+  int numThreads = std::min(numThreads_, std::max(1, (int) functions_.size()));
+
+  // Deal the functions out largest first, so every queue starts on its biggest ones and only small ones are left
+  // to steal near the end
+  vector<int> order(functions_.size());
+  for (int i = 0; i < order.size(); i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return functions_[a].first.size() + functions_[a].second.size()
+        > functions_[b].first.size() + functions_[b].second.size();
+  });
+
+  vector<WorkQueue> queues(numThreads);
+  for (int i = 0; i < order.size(); i++) {
+    queues[i % numThreads].functions.push_back(order[i]);
+  }
+
+  vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back(&BatchSimplifier::work, this, t, std::ref(queues));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  return essentialPrimes_;
+}
+
+/**
+ * Runs on each thread, simplifying functions until no queue has any left
+ * The thread reuses one LogicSimplifier for all of its functions, so the ones table rows and implicant vectors keep
+ * their memory from one function to the next
+ *
+ * @param thread The index of this thread's queue
+ * @param queues Every thread's queue
+ */
+void BatchSimplifier::work(int thread, vector<WorkQueue> &queues) {
+  LogicSimplifier simplifier;
+  // The batch already keeps every thread busy
+  simplifier.setThreads(1);
+
+  int function;
+  while (takeFunction(thread, queues, function)) {
+    simplifier.reset(functions_[function].first, functions_[function].second);
+    essentialPrimes_[function] = simplifier.simplify();
+    equations_[function] = simplifier.getEquation();
+  }
+}
+
+/**
+ * Takes the next (largest) function from this thread's own queue, or steals the last (smallest) one from another
+ * thread's queue when its own is empty
+ *
+ * @param thread The index of this thread's queue
+ * @param queues Every thread's queue
+ * @param function Set to the index of the function taken
+ * @return false if every queue is empty
+ */
+bool BatchSimplifier::takeFunction(int thread, vector<WorkQueue> &queues, int &function) {
+  {
+    std::lock_guard<std::mutex> guard(queues[thread].lock);
+    if (!queues[thread].functions.empty()) {
+      function = queues[thread].functions.front();
+      queues[thread].functions.pop_front();
+      return true;
+    }
+  }
+
+  for (int i = 1; i < queues.size(); i++) {
+    WorkQueue &victim = queues[(thread + i) % queues.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.functions.empty()) {
+      function = victim.functions.back();
+      victim.functions.pop_back();
+      return true;
+    }
+  }
+
+  // Functions are never added once simplify() starts, so once every queue is empty there is nothing left to do
+  return false;
+}
+
+vector<string> BatchSimplifier::getEquations() {
+  return equations_;
+}
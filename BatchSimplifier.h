@@ -0,0 +1,37 @@
+#ifndef QUINE_MCCLUSKEY_ALGORITHM_BATCHSIMPLIFIER_H
+#define QUINE_MCCLUSKEY_ALGORITHM_BATCHSIMPLIFIER_H
+
+#include <set>
+#include <deque>
+#include <mutex>
+#include "LogicSimplifier.h"
+
+/**
+ * Simplifies many independent functions at once, spreading them over a pool of threads
+ * Each thread keeps its own queue of functions, largest first, and steals from the others once it runs out
+ */
+class BatchSimplifier {
+ public:
+  explicit BatchSimplifier(vector<std::pair<vector<int>, vector<int>>>);
+  BatchSimplifier(vector<std::pair<vector<int>, vector<int>>>, int);
+
+  vector<std::set<Implicant>> simplify();
+  vector<string> getEquations();
+
+ private:
+  struct WorkQueue {
+    std::mutex lock;
+    std::deque<int> functions;
+  };
+
+  vector<std::pair<vector<int>, vector<int>>> functions_;
+  int numThreads_;
+
+  vector<std::set<Implicant>> essentialPrimes_;
+  vector<string> equations_;
+
+  void work(int, vector<WorkQueue> &);
+  bool takeFunction(int, vector<WorkQueue> &, int &);
+};
+
+#endif //QUINE_MCCLUSKEY_ALGORITHM_BATCHSIMPLIFIER_H
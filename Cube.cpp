@@ -0,0 +1,78 @@
+#include "Cube.h"
+
+/**
+ * Packs a bitstring such as "01-1" into a cube
+ *
+ * @param bitstring The bitstring to pack
+ * @return The cube the bitstring stands for
+ */
+Cube Cube::fromBitstring(string bitstring) {
+  Cube cube = {0, 0};
+  for (char c : bitstring) {
+    cube.value <<= 1;
+    cube.dashes <<= 1;
+    if (c == '1') cube.value |= 1;
+    else if (c == '-') cube.dashes |= 1;
+  }
+  return cube;
+}
+
+bool Cube::covers(int minterm) const {
+  return ((uint64_t) minterm & ~dashes) == value;
+}
+
+int Cube::numDashes() const {
+  int count = 0;
+  for (uint64_t d = dashes; d != 0; d &= d - 1) count++;
+  return count;
+}
+
+/**
+ * @return Every minterm the cube covers, in increasing order
+ */
+vector<int> Cube::minterms() const {
+  // Walk every subset of the dash bits
+  vector<int> minterms;
+  uint64_t subset = 0;
+  do {
+    minterms.push_back((int) (value | subset));
+    subset = (subset - dashes) & dashes;
+  } while (subset != 0);
+  return minterms;
+}
+
+/**
+ * @param numVariables The length of the bitstring
+ * @return The cube as a bitstring such as "01-1"
+ */
+string Cube::toBitstring(int numVariables) const {
+  string bitstring;
+  for (int i = numVariables - 1; i >= 0; i--) {
+    if ((dashes >> i) & 1) bitstring += '-';
+    else if ((value >> i) & 1) bitstring += '1';
+    else bitstring += '0';
+  }
+  return bitstring;
+}
+
+/**
+ * Unpacks the cube into an implicant, listing every minterm it covers as a parent
+ *
+ * @param numVariables The length of the bitstring
+ * @param included Whether the implicant has been combined into a larger one
+ * @return The implicant holding the same cube
+ */
+Implicant Cube::toImplicant(int numVariables, bool included) const {
+  return Implicant(minterms(), toBitstring(numVariables), included);
+}
+
+bool Cube::operator<(const Cube &c) const {
+  if (dashes != c.dashes)
+    return dashes < c.dashes;
+  else
+    return value < c.value;
+}
+
+bool Cube::operator==(const Cube &c) const {
+  return dashes == c.dashes && value == c.value;
+}
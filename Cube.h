@@ -0,0 +1,26 @@
+#ifndef QUINE_MCCLUSKEY_ALGORITHM_CUBE_H
+#define QUINE_MCCLUSKEY_ALGORITHM_CUBE_H
+
+#include <cstdint>
+#include "Implicant.h"
+
+// A cube of up to 64 variables, bit i standing for the variable at bitstring index (numVariables - 1 - i)
+// value holds the 1s of the cube's literals and dashes its missing variables, so value is its smallest minterm and
+// the cube covers every combination of value with the dash bits
+struct Cube {
+  uint64_t value;
+  uint64_t dashes;
+
+  static Cube fromBitstring(string);
+
+  bool covers(int) const;
+  int numDashes() const;
+  vector<int> minterms() const;
+  string toBitstring(int) const;
+  Implicant toImplicant(int, bool = false) const;
+
+  bool operator<(const Cube &) const;
+  bool operator==(const Cube &) const;
+};
+
+#endif //QUINE_MCCLUSKEY_ALGORITHM_CUBE_H
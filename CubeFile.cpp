@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CubeFile.h"
+
+// Number of records collected before append() writes them out
+static const size_t BUFFER_RECORDS = 4096;
+
+/**
+ * Creates (or truncates) the file at path, or opens the records already in it
+ *
+ * @param path Where to keep the records
+ * @param existing Whether to keep the records already in the file
+ */
+CubeFile::CubeFile(string path, bool existing)
+    : path_{path}, fd_(-1), records_(nullptr), size_(0) {
+  fd_ = open(path_.c_str(), existing ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd_ < 0) {
+    fail("open");
+    return;
+  }
+
+  if (existing) {
+    struct stat info;
+    if (fstat(fd_, &info) < 0) {
+      fail("fstat");
+      return;
+    }
+    size_ = info.st_size / sizeof(CubeRecord);
+    lseek(fd_, 0, SEEK_END);
+  }
+}
+
+CubeFile::~CubeFile() {
+  unmap();
+  if (fd_ >= 0) {
+    flush();
+    close(fd_);
+  }
+}
+
+/**
+ * Adds a record to the end of the file
+ * Records are buffered and written in large sequential chunks
+ *
+ * @param record The record to add
+ */
+void CubeFile::append(const CubeRecord &record) {
+  if (!good()) return;
+  buffer_.push_back(record);
+  size_++;
+  if (buffer_.size() >= BUFFER_RECORDS) flush();
+}
+
+void CubeFile::flush() {
+  if (!good()) {
+    buffer_.clear();
+    return;
+  }
+
+  const char *data = reinterpret_cast<const char *>(buffer_.data());
+  size_t remaining = buffer_.size() * sizeof(CubeRecord);
+  while (remaining > 0) {
+    ssize_t written = write(fd_, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      fail("write");
+      return;
+    }
+    data += written;
+    remaining -= written;
+  }
+  buffer_.clear();
+}
+
+/**
+ * Maps every record in the file into memory so they can be read and updated with operator[]
+ */
+void CubeFile::map() {
+  if (records_ != nullptr) return;
+  flush();
+  if (!good() || size_ == 0) return;
+
+  void *address = mmap(nullptr, size_ * sizeof(CubeRecord), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (address == MAP_FAILED) {
+    fail("mmap");
+    return;
+  }
+  records_ = static_cast<CubeRecord *>(address);
+}
+
+void CubeFile::unmap() {
+  if (records_ == nullptr) return;
+  munmap(records_, size_ * sizeof(CubeRecord));
+  records_ = nullptr;
+}
+
+/**
+ * Sorts the records by their dashes then value and drops any duplicates, shrinking the file to fit
+ * Leaves the file unmapped
+ */
+void CubeFile::sortUnique() {
+  map();
+  if (records_ != nullptr) {
+    std::sort(records_, records_ + size_, [](const CubeRecord &a, const CubeRecord &b) {
+      return a.cube < b.cube;
+    });
+    size_t unique = std::unique(records_, records_ + size_, [](const CubeRecord &a, const CubeRecord &b) {
+      return a.cube == b.cube;
+    }) - records_;
+    unmap();
+    size_ = unique;
+    if (ftruncate(fd_, size_ * sizeof(CubeRecord)) < 0) fail("ftruncate");
+  }
+}
+
+/**
+ * Deletes the file from disk, the records can no longer be used afterwards
+ */
+void CubeFile::remove() {
+  unmap();
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+  size_ = 0;
+  buffer_.clear();
+  unlink(path_.c_str());
+}
+
+/**
+ * Checks whether every operation on the file so far has succeeded
+ * Once one fails the file holds no records and further operations do nothing, see getError() for why
+ *
+ * @return false if an operation failed
+ */
+bool CubeFile::good() {
+  return error_.empty();
+}
+
+string CubeFile::getError() {
+  return error_;
+}
+
+/**
+ * Records the failed system call along with errno, and drops every record since they can no longer be trusted
+ */
+void CubeFile::fail(const string &what) {
+  if (error_.empty()) error_ = what + " " + path_ + ": " + std::strerror(errno);
+  unmap();
+  size_ = 0;
+}
+
+size_t CubeFile::size() {
+  return size_;
+}
+
+CubeRecord &CubeFile::operator[](size_t i) {
+  return records_[i];
+}
+
+/**
+ * Packs a bitstring such as "01-1" into a record
+ *
+ * @param bitstring The bitstring to pack
+ * @return The record holding the same cube
+ */
+CubeRecord CubeFile::toRecord(string bitstring) {
+  return {Cube::fromBitstring(bitstring), 0, 0};
+}
+
+/**
+ * Unpacks a record into an implicant, listing every minterm it covers as a parent
+ *
+ * @param record The record to unpack
+ * @param numVariables The length of the bitstring
+ * @return The implicant holding the same cube
+ */
+Implicant CubeFile::toImplicant(const CubeRecord &record, int numVariables) {
+  return record.cube.toImplicant(numVariables, record.included != 0);
+}
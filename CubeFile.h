@@ -0,0 +1,51 @@
+#ifndef QUINE_MCCLUSKEY_ALGORITHM_CUBEFILE_H
+#define QUINE_MCCLUSKEY_ALGORITHM_CUBEFILE_H
+
+#include "Cube.h"
+
+// Fixed width on-disk form of an implicant
+struct CubeRecord {
+  Cube cube;
+  uint32_t included;
+  uint32_t padding;
+};
+
+/**
+ * A file of CubeRecords that is written sequentially and then memory mapped to be read and updated in place
+ * Used to keep the levels of the ones table on disk instead of in memory
+ * Failed system calls don't throw or exit, they are reported through good() and getError()
+ */
+class CubeFile {
+ public:
+  explicit CubeFile(string, bool = false);
+  ~CubeFile();
+  CubeFile(const CubeFile &) = delete;
+  CubeFile &operator=(const CubeFile &) = delete;
+
+  void append(const CubeRecord &);
+  void map();
+  void unmap();
+  void sortUnique();
+  void remove();
+
+  bool good();
+  string getError();
+  size_t size();
+  CubeRecord &operator[](size_t);
+
+  static CubeRecord toRecord(string);
+  static Implicant toImplicant(const CubeRecord &, int);
+
+ private:
+  string path_;
+  int fd_;
+  CubeRecord *records_;
+  size_t size_;
+  vector<CubeRecord> buffer_;
+  string error_;
+
+  void flush();
+  void fail(const string &);
+};
+
+#endif //QUINE_MCCLUSKEY_ALGORITHM_CUBEFILE_H
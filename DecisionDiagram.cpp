@@ -0,0 +1,210 @@
+#include <algorithm>
+#include "DecisionDiagram.h"
+
+/**
+ * Creates a node store for functions of the given number of variables, holding only the two terminals
+ *
+ * @param numVariables The number of variables of the function
+ */
+DecisionDiagram::DecisionDiagram(int numVariables)
+    : numVariables_(numVariables) {
+  // Terminals sit below every variable
+  bddNodes_.push_back({numVariables_, 0, 0});
+  bddNodes_.push_back({numVariables_, 1, 1});
+  zddNodes_.push_back({2 * numVariables_, 0, 0});
+  zddNodes_.push_back({2 * numVariables_, 1, 1});
+}
+
+uint64_t DecisionDiagram::key(int a, int b) {
+  return ((uint64_t) (uint32_t) a << 32) | (uint32_t) b;
+}
+
+/**
+ * Finds or creates the BDD node testing var, skipping the test when both branches are the same
+ */
+int DecisionDiagram::bddNode(int var, int lo, int hi) {
+  if (lo == hi) return lo;
+
+  Node node = {var, lo, hi};
+  auto it = bddUnique_.find(node);
+  if (it != bddUnique_.end()) return it->second;
+
+  bddNodes_.push_back(node);
+  return bddUnique_[node] = bddNodes_.size() - 1;
+}
+
+/**
+ * Finds or creates the ZDD node for var, dropping it when no cube contains var
+ */
+int DecisionDiagram::zddNode(int var, int lo, int hi) {
+  if (hi == 0) return lo;
+
+  Node node = {var, lo, hi};
+  auto it = zddUnique_.find(node);
+  if (it != zddUnique_.end()) return it->second;
+
+  zddNodes_.push_back(node);
+  return zddUnique_[node] = zddNodes_.size() - 1;
+}
+
+/**
+ * Builds the BDD that is true exactly on the given minterms
+ *
+ * @param minterms The minterms of the function
+ * @return The root of the BDD
+ */
+int DecisionDiagram::bddFromMinterms(vector<int> minterms) {
+  std::sort(minterms.begin(), minterms.end());
+  minterms.erase(std::unique(minterms.begin(), minterms.end()), minterms.end());
+  return bddBuild(minterms, 0, 0, minterms.size());
+}
+
+/**
+ * Builds the BDD for minterms[begin, end), which all agree on the variables before var
+ * Being sorted, the minterms with a 0 for var all come before the ones with a 1
+ */
+int DecisionDiagram::bddBuild(vector<int> &minterms, int var, int begin, int end) {
+  if (begin == end) return 0;
+  if (var == numVariables_) return 1;
+
+  int bit = numVariables_ - 1 - var;
+  int middle = begin;
+  while (middle < end && !((minterms[middle] >> bit) & 1)) middle++;
+
+  int lo = bddBuild(minterms, var + 1, begin, middle);
+  int hi = bddBuild(minterms, var + 1, middle, end);
+  return bddNode(var, lo, hi);
+}
+
+int DecisionDiagram::bddAnd(int a, int b) {
+  if (a == 0 || b == 0) return 0;
+  if (a == 1) return b;
+  if (b == 1 || a == b) return a;
+  if (a > b) std::swap(a, b);
+
+  auto it = andCache_.find(key(a, b));
+  if (it != andCache_.end()) return it->second;
+
+  Node na = bddNodes_[a], nb = bddNodes_[b];
+  int var = std::min(na.var, nb.var);
+  int lo = bddAnd(na.var == var ? na.lo : a, nb.var == var ? nb.lo : b);
+  int hi = bddAnd(na.var == var ? na.hi : a, nb.var == var ? nb.hi : b);
+  return andCache_[key(a, b)] = bddNode(var, lo, hi);
+}
+
+/**
+ * Computes the set of prime implicants of a BDD as a ZDD of cubes (Coudert and Madre)
+ * With f0 and f1 the cofactors on the top variable x, the primes are those of f0 * f1, plus x' or x in front of the
+ * primes of f0 or f1 that aren't primes of f0 * f1
+ *
+ * @param f The root of the BDD
+ * @return The root of the ZDD of its primes
+ */
+int DecisionDiagram::zddPrimes(int f) {
+  if (f <= 1) return f;
+
+  auto it = primesCache_.find(f);
+  if (it != primesCache_.end()) return it->second;
+
+  Node node = bddNodes_[f];
+  int both = zddPrimes(bddAnd(node.lo, node.hi));
+  int negative = zddDiff(zddPrimes(node.lo), both);
+  int positive = zddDiff(zddPrimes(node.hi), both);
+
+  int result = zddNode(2 * node.var, zddNode(2 * node.var + 1, both, positive), negative);
+  return primesCache_[f] = result;
+}
+
+int DecisionDiagram::zddDiff(int a, int b) {
+  if (a == 0 || a == b) return 0;
+  if (b == 0) return a;
+
+  auto it = diffCache_.find(key(a, b));
+  if (it != diffCache_.end()) return it->second;
+
+  Node na = zddNodes_[a], nb = zddNodes_[b];
+  int result;
+  if (na.var < nb.var)
+    result = zddNode(na.var, zddDiff(na.lo, b), na.hi);
+  else if (na.var > nb.var)
+    result = zddDiff(a, nb.lo);
+  else
+    result = zddNode(na.var, zddDiff(na.lo, nb.lo), zddDiff(na.hi, nb.hi));
+  return diffCache_[key(a, b)] = result;
+}
+
+/**
+ * Lists the cubes of a ZDD that cover the given minterm, i.e. the ones with no literal the minterm contradicts
+ * Only walks the branches the minterm allows and creates no nodes, so it can be called once per minterm without
+ * growing the diagram
+ *
+ * @param z The root of the ZDD
+ * @param minterm The minterm to cover
+ * @return Every cube of z covering minterm
+ */
+vector<Cube> DecisionDiagram::zddCovering(int z, int minterm) {
+  coveringCounts_.clear();
+
+  vector<Cube> cubes;
+  Cube cube = {0, numVariables_ == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << numVariables_) - 1};
+  zddCovering(z, minterm, cube, cubes);
+  return cubes;
+}
+
+/**
+ * Counts the cubes of a ZDD that cover the given minterm, without listing them
+ *
+ * @param z The root of the ZDD
+ * @param minterm The minterm to cover
+ * @return The number of cubes of z covering minterm
+ */
+uint64_t DecisionDiagram::zddCoveringCount(int z, int minterm) {
+  coveringCounts_.clear();
+  return coveringCount(z, minterm);
+}
+
+/**
+ * Counts the cubes below z that cover minterm, so zddCovering() can skip branches that lead nowhere
+ */
+uint64_t DecisionDiagram::coveringCount(int z, int minterm) {
+  if (z <= 1) return z;
+
+  auto it = coveringCounts_.find(z);
+  if (it != coveringCounts_.end()) return it->second;
+
+  Node node = zddNodes_[z];
+  int bit = (minterm >> (numVariables_ - 1 - node.var / 2)) & 1;
+  bool allowed = (node.var % 2 == 1) == (bit == 1);
+
+  uint64_t count = coveringCount(node.lo, minterm) + (allowed ? coveringCount(node.hi, minterm) : 0);
+  return coveringCounts_[z] = count;
+}
+
+void DecisionDiagram::zddCovering(int z, int minterm, Cube &cube, vector<Cube> &cubes) {
+  if (coveringCount(z, minterm) == 0) return;
+  if (z == 1) {
+    cubes.push_back(cube);
+    return;
+  }
+
+  Node node = zddNodes_[z];
+  zddCovering(node.lo, minterm, cube, cubes);
+
+  // Cubes with a literal the minterm contradicts don't cover it
+  uint64_t bit = (uint64_t) 1 << (numVariables_ - 1 - node.var / 2);
+  if ((node.var % 2 == 1) != ((minterm & bit) != 0)) return;
+
+  Cube literal = cube;
+  literal.dashes &= ~bit;
+  if (node.var % 2 == 1) literal.value |= bit;
+  zddCovering(node.hi, minterm, literal, cubes);
+}
+
+/**
+ * Frees the operation caches, which are only needed while computing primes
+ */
+void DecisionDiagram::clearCaches() {
+  andCache_ = {};
+  primesCache_ = {};
+  diffCache_ = {};
+}
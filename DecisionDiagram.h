@@ -0,0 +1,67 @@
+#ifndef QUINE_MCCLUSKEY_ALGORITHM_DECISIONDIAGRAM_H
+#define QUINE_MCCLUSKEY_ALGORITHM_DECISIONDIAGRAM_H
+
+#include <unordered_map>
+#include "Cube.h"
+
+/**
+ * Shared BDD and ZDD node store used to find prime implicants without listing them
+ *
+ * BDDs represent a function of numVariables variables, variable 0 being the first character of a bitstring
+ * ZDDs represent sets of cubes, with ZDD variable 2i standing for the literal i' and 2i + 1 for the literal i
+ * In both, node 0 is false / the empty set and node 1 is true / the set holding only the empty cube
+ */
+class DecisionDiagram {
+ public:
+  explicit DecisionDiagram(int);
+
+  int bddFromMinterms(vector<int>);
+  int bddAnd(int, int);
+
+  int zddPrimes(int);
+  int zddDiff(int, int);
+  vector<Cube> zddCovering(int, int);
+  uint64_t zddCoveringCount(int, int);
+  void clearCaches();
+
+ private:
+  struct Node {
+    int var;
+    int lo;
+    int hi;
+
+    bool operator==(const Node &n) const {
+      return var == n.var && lo == n.lo && hi == n.hi;
+    }
+  };
+
+  struct NodeHash {
+    size_t operator()(const Node &n) const {
+      return std::hash<uint64_t>()(((uint64_t) (uint32_t) n.lo << 32 | (uint32_t) n.hi) * 31 + n.var);
+    }
+  };
+
+  int numVariables_;
+
+  vector<Node> bddNodes_;
+  vector<Node> zddNodes_;
+  std::unordered_map<Node, int, NodeHash> bddUnique_;
+  std::unordered_map<Node, int, NodeHash> zddUnique_;
+
+  std::unordered_map<uint64_t, int> andCache_;
+  std::unordered_map<int, int> primesCache_;
+  std::unordered_map<uint64_t, int> diffCache_;
+
+  // zddCovering() and zddCoveringCount() scratch, reused between calls
+  std::unordered_map<int, uint64_t> coveringCounts_;
+
+  int bddNode(int, int, int);
+  int zddNode(int, int, int);
+  int bddBuild(vector<int> &, int, int, int);
+  uint64_t coveringCount(int, int);
+  void zddCovering(int, int, Cube &, vector<Cube> &);
+
+  static uint64_t key(int, int);
+};
+
+#endif //QUINE_MCCLUSKEY_ALGORITHM_DECISIONDIAGRAM_H
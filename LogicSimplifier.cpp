@@ -6,12 +6,65 @@
 #include <algorithm>
 #include <set>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <cerrno>
+#include <deque>
+#include <unordered_set>
 #include "LogicSimplifier.h"
 
+// Fewest prime table cells (rows x columns, summed over all groups) worth starting threads for in coverComponents()
+static const int PARALLEL_COVER_CELLS = 1 << 14;
+
+// Rows and columns of the prime table are bitsets, 64 cells to a word
+
+static bool hasBit(const vector<uint64_t> &bits, int i) {
+  return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+static void setBit(vector<uint64_t> &bits, int i) {
+  bits[i / 64] |= (uint64_t) 1 << (i % 64);
+}
+
+static void clearBit(vector<uint64_t> &bits, int i) {
+  bits[i / 64] &= ~((uint64_t) 1 << (i % 64));
+}
+
+/**
+ * @return true if every bit set in a is set in b
+ */
+static bool isSubset(const vector<uint64_t> &a, const vector<uint64_t> &b) {
+  for (int w = 0; w < a.size(); w++) {
+    if (a[w] & ~b[w]) return false;
+  }
+  return true;
+}
+
+/**
+ * @return The indices of the set bits, in increasing order
+ */
+static vector<int> bitIndices(const vector<uint64_t> &bits) {
+  vector<int> indices;
+  for (int w = 0; w < bits.size(); w++) {
+    for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+      indices.push_back(w * 64 + __builtin_ctzll(word));
+    }
+  }
+  return indices;
+}
+
 ///     CONSTRUCTORS     ///////////////////////////////////////////////////////////////////////////////////////////////
 
-LogicSimplifier::LogicSimplifier() {
-  // default constructor ???
+/**
+ * Default constructor with no function, call reset() to give it one
+ */
+LogicSimplifier::LogicSimplifier()
+    : alphabet_{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"} {
 }
 
 /**
@@ -77,7 +130,7 @@ void LogicSimplifier::setup() {
   }
 
   // Set up equation to be " F(A,B,...) = "
-  equation_ += literals_[0];
+  if (!literals_.empty()) equation_ += literals_[0];
   for (int i = 1; i < literals_.size(); i++) {
     equation_ += ',';
     equation_ += literals_[i];
@@ -88,6 +141,28 @@ void LogicSimplifier::setup() {
   fillTable();
 }
 
+/**
+ * Clears everything left from a previous simplification and starts over with a new function
+ * Keeps the settings, the capacity of the implicant and minterm vectors and the rows of the ones table, so one
+ * simplifier can be reused for many functions without allocating them again
+ * The prime table is rebuilt for each function, since covering clears it
+ *
+ * @param minterms The minterms of the function to simplify
+ * @param dontCares The "dont care's" of the function to simplify
+ */
+void LogicSimplifier::reset(vector<int> minterms, vector<int> dontCares) {
+  // fillTable() empties the ones table's rows in place
+  implicants_.clear();
+  clearPrimeTable();
+  essentialPrimeImplicants_.clear();
+
+  minterms_.assign(minterms.begin(), minterms.end());
+  dontCares_.assign(dontCares.begin(), dontCares.end());
+  equation_ = "F(";
+
+  setup();
+}
+
 /**
  * Adds each implicant in its proper row in the ones table
  * Row 0: implicants with bitstring containing no 1s
@@ -96,7 +171,7 @@ void LogicSimplifier::setup() {
  */
 void LogicSimplifier::fillTable() {
   // Make table appropriate size (with n variables, rows 0,1,2,...,n  :  need n+1 rows)
-  table_.resize(numVariables_ + 1);
+  resizeTable(numVariables_ + 1);
   for (auto &implicant : implicants_) {
     // Count ones in the bitstring and push_back to appropriate row in table
     int ones = countOnes(implicant.getBitstring());
@@ -104,21 +179,85 @@ void LogicSimplifier::fillTable() {
   }
 }
 
+/**
+ * Empties the ones table and gives it the given number of rows
+ * Rows are moved to and from the spare rows in nextTable_ rather than freed and allocated, so their memory is reused
+ *
+ * @param rows The number of rows
+ */
+void LogicSimplifier::resizeTable(int rows) {
+  for (auto &row : table_) {
+    row.clear();
+  }
+  while (table_.size() > rows) {
+    nextTable_.push_back(std::move(table_.back()));
+    table_.pop_back();
+  }
+  while (table_.size() < rows && !nextTable_.empty()) {
+    table_.push_back(std::move(nextTable_.back()));
+    nextTable_.pop_back();
+    table_.back().clear();
+  }
+  table_.resize(rows);
+}
+
 /**
  *
  * @return
  */
 std::set<Implicant> LogicSimplifier::simplify() {
+  // The primes never get listed, so there is no prime table to reduce
+  if (implicitPrimes_) {
+    coverImplicitPrimes();
+    essentialsToEquation();
+    return essentialPrimeImplicants_;
+  }
+
+  if (shardVariables_ > 0)
+    generatePrimesSharded();
+  else if (spillDirectory_.empty())
+    generatePrimes();
+  else
+    generatePrimesOutOfCore();
+
+  setupPrimeTable();
+
+  // Shrink the prime table down to its cyclic core, then cover each independent piece of what is left
+  reduceToCyclicCore();
+  coverComponents();
+  essentialsToEquation();
+  return essentialPrimeImplicants_;
+
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/**
+ * Combines the ones table level by level in memory, collecting every implicant that can't be combined any further
+ * into primeImplicants_
+ */
+void LogicSimplifier::generatePrimes() {
   // Simplify table until it has one row left
   while (table_.size() > 1) {
-    // Declare newTable for next iteration
-    vector<vector<Implicant>> newTable;
-
-    // Compare each pair of rows and add their reduced combination to the new table
+    // Compare each pair of rows and add their reduced combination to the next table, reusing its spare rows
+    int rows = 0;
     for (int i = 0; i < table_.size() - 1; i++) {
       // Only compare if row isn't empty
-      if (!table_[i].empty())
-        newTable.push_back(compare(table_[i], table_[i + 1]));
+      if (!table_[i].empty()) {
+        if (rows == nextTable_.size()) nextTable_.emplace_back();
+        compare(table_[i], table_[i + 1], nextTable_[rows++]);
+      }
     }
 
     // Loop through every implicant in the old table...
@@ -134,121 +273,778 @@ std::set<Implicant> LogicSimplifier::simplify() {
 
       }
     }
-    table_ = newTable;
-  }
 
-  extractEssentials();
-  while (minterms_.size() > 0) {
-    extractCover();
+    // Swap rather than copy, the old rows and any unused ones become the spare rows for the next level
+    table_.swap(nextTable_);
+    while (table_.size() > rows) {
+      nextTable_.push_back(std::move(table_.back()));
+      table_.pop_back();
+    }
   }
-  essentialsToEquation();
-  return essentialPrimeImplicants_;
 
+  // Nothing is left to compare the last row with, so all of it is prime
+  for (auto &row : table_) {
+    for (auto &implicant : row) {
+      if (std::find(primeImplicants_.begin(), primeImplicants_.end(), implicant) == primeImplicants_.end())
+        primeImplicants_.push_back(implicant);
+    }
+  }
+  resizeTable(0);
 }
 
+/**
+ * Same as generatePrimes(), but each ones-count group of a level lives in its own CubeFile under spillDirectory_
+ * Only the two groups being compared are mapped at a time and the next level is written out sequentially, so the
+ * table never has to fit in memory
+ */
+void LogicSimplifier::generatePrimesOutOfCore() {
+  // Records pack one bit per variable into 64 bits
+  if (numVariables_ > 64) {
+    std::cerr << "Too many variables to spill the ones table, keeping it in memory..." << endl;
+    generatePrimes();
+    return;
+  }
 
+  // Keep this simplifier's files in their own directory so several can share spillDirectory_
+  string dirTemplate = spillDirectory_ + "/qm-XXXXXX";
+  vector<char> dirBuffer(dirTemplate.begin(), dirTemplate.end());
+  dirBuffer.push_back('\0');
+  if (mkdtemp(dirBuffer.data()) == nullptr) {
+    std::cerr << "Could not create a directory in " << spillDirectory_ << ", keeping the ones table in memory..."
+              << endl;
+    generatePrimes();
+    return;
+  }
+  string dir = dirBuffer.data();
+
+  auto groupPath = [&](int level, int group) {
+    return dir + "/level" + std::to_string(level) + "_group" + std::to_string(group) + ".cubes";
+  };
+
+  // Write the starting table out to disk and release it
+  vector<std::unique_ptr<CubeFile>> groups;
+  vector<std::unique_ptr<CubeFile>> nextGroups;
+  CubeFile *failed = nullptr;
+  for (int i = 0; i < table_.size() && failed == nullptr; i++) {
+    groups.emplace_back(new CubeFile(groupPath(0, i)));
+    for (auto &implicant : table_[i]) {
+      groups[i]->append(CubeFile::toRecord(implicant.getBitstring()));
+    }
+    groups[i]->sortUnique();
+    if (!groups[i]->good()) failed = groups[i].get();
+  }
+  if (failed == nullptr) table_.clear();
+
+  for (int level = 0; !groups.empty() && failed == nullptr; level++) {
+    // Combining group i with group i + 1 produces group i of the next level
+    nextGroups.clear();
+    size_t nextSize = 0;
+    for (int i = 0; i + 1 < groups.size(); i++) {
+      nextGroups.emplace_back(new CubeFile(groupPath(level + 1, i)));
+    }
 
+    for (int i = 0; i < groups.size() && failed == nullptr; i++) {
+      groups[i]->map();
+      if (!groups[i]->good()) {
+        failed = groups[i].get();
+        break;
+      }
 
+      if (i + 1 < groups.size()) {
+        groups[i + 1]->map();
+        compare(*groups[i], *groups[i + 1], *nextGroups[i]);
+        nextGroups[i]->sortUnique();
+        nextSize += nextGroups[i]->size();
 
+        if (!groups[i + 1]->good()) failed = groups[i + 1].get();
+        else if (!nextGroups[i]->good()) failed = nextGroups[i].get();
+        if (failed != nullptr) break;
+      }
 
+      // Group i has now been compared with both of its neighbours, anything not included is prime
+      for (size_t j = 0; j < groups[i]->size(); j++) {
+        if (!(*groups[i])[j].included)
+          primeImplicants_.push_back(CubeFile::toImplicant((*groups[i])[j], numVariables_));
+      }
+      groups[i]->remove();
+    }
+    if (failed != nullptr) break;
 
+    if (nextSize == 0) {
+      for (auto &group : nextGroups) {
+        group->remove();
+      }
+      nextGroups.clear();
+    }
+    groups = std::move(nextGroups);
+    nextGroups.clear();
+  }
 
+  // A full disk or similar shouldn't lose the simplification, start over in memory
+  if (failed != nullptr) {
+    std::cerr << "Could not spill the ones table (" << failed->getError() << "), keeping it in memory..." << endl;
+  }
 
+  for (auto &group : groups) {
+    group->remove();
+  }
+  for (auto &group : nextGroups) {
+    group->remove();
+  }
+  rmdir(dir.c_str());
 
+  if (failed != nullptr) {
+    primeImplicants_.clear();
+    table_.clear();
+    fillTable();
+    generatePrimes();
+  }
+}
 
+/**
+ * Deletes a directory along with every file in it
+ */
+static void removeDirectory(const string &dir) {
+  DIR *stream = opendir(dir.c_str());
+  if (stream != nullptr) {
+    for (dirent *entry = readdir(stream); entry != nullptr; entry = readdir(stream)) {
+      string name = entry->d_name;
+      if (name != "." && name != "..") unlink((dir + "/" + name).c_str());
+    }
+    closedir(stream);
+  }
+  rmdir(dir.c_str());
+}
 
+/**
+ * Runs job(k) for every k in [0, count) in its own forked worker process, with at most one worker per hardware
+ * thread at a time
+ * Only waits on the workers it started, so other children of the program are left alone
+ *
+ * @param count The number of jobs
+ * @param job The job to run in each worker, returning whether it succeeded
+ * @return true if every worker was started and exited successfully
+ */
+bool LogicSimplifier::runWorkers(int count, const std::function<bool(int)> &job) {
+  int maxWorkers = std::max(1, (int) std::thread::hardware_concurrency());
+
+  auto reap = [](pid_t pid) {
+    int status;
+    pid_t result;
+    do {
+      result = waitpid(pid, &status, 0);
+    } while (result < 0 && errno == EINTR);
+    return result == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  };
+
+  std::deque<pid_t> running;
+  bool succeeded = true;
+  for (int k = 0; k < count; k++) {
+    if ((int) running.size() == maxWorkers) {
+      succeeded &= reap(running.front());
+      running.pop_front();
+    }
 
+    pid_t pid = fork();
+    if (pid < 0) {
+      succeeded = false;
+      break;
+    }
+    // Worker: _exit() so the program's atexit handlers and stdio buffers are left to the parent
+    if (pid == 0) _exit(job(k) ? EXIT_SUCCESS : EXIT_FAILURE);
+    running.push_back(pid);
+  }
 
-void LogicSimplifier::setupPrimeTable() {
+  for (pid_t pid : running) {
+    succeeded &= reap(pid);
+  }
+  return succeeded;
+}
 
-  primeTable_.resize(primeImplicants_.size());
-  for (auto &r : primeTable_) {
-    r.resize(minterms_.size());
+/**
+ * Splits the minterms and dont cares into shards by the value of their first shardVariables_ variables and finds the
+ * primes of each shard in its own worker process, which writes them to a CubeFile under shardDirectory_
+ * The shards are then merged one variable at a time, each pair of shards by another worker with mergeShards(), until
+ * a single file holds the primes of the whole function
+ */
+void LogicSimplifier::generatePrimesSharded() {
+  int prefix = std::min(shardVariables_, numVariables_);
+  int suffix = numVariables_ - prefix;
+
+  // Records pack one bit per variable into 64 bits
+  if (numVariables_ > 64) {
+    std::cerr << "Too many variables to shard, generating primes in this process..." << endl;
+    generatePrimes();
+    return;
   }
 
-  for (int r = 0; r < primeImplicants_.size(); r++) {
-    vector<int> parents = primeImplicants_[r].getParents();
+  string dirTemplate = shardDirectory_ + "/qm-shards-XXXXXX";
+  vector<char> dirBuffer(dirTemplate.begin(), dirTemplate.end());
+  dirBuffer.push_back('\0');
+  if (mkdtemp(dirBuffer.data()) == nullptr) {
+    std::cerr << "Could not create a directory in " << shardDirectory_ << ", generating primes in this process..."
+              << endl;
+    generatePrimes();
+    return;
+  }
+  string dir = dirBuffer.data();
 
-    for (int c = 0; c < minterms_.size(); c++) {
-      int mintermNumber = minterms_[c];
+  auto shardPath = [&](int level, int shard) {
+    return dir + "/level" + std::to_string(level) + "_shard" + std::to_string(shard) + ".cubes";
+  };
 
-      if (std::find(parents.begin(), parents.end(), mintermNumber) != parents.end()) {
-        primeTable_[r][c] = true;
+  // Workers only need the shard's minterms, the ones table isn't used
+  table_.clear();
+  vector<vector<int>> shards(1 << prefix);
+  for (int m : dontCares_) {
+    shards[m >> suffix].push_back(m & ((1 << suffix) - 1));
+  }
+
+  bool succeeded = runWorkers(shards.size(), [&](int k) {
+    CubeFile out(shardPath(0, k));
+    if (!shards[k].empty()) {
+      // The shard is a function of the last suffix variables, numbered from 0
+      LogicSimplifier shard(shards[k], {});
+      shard.spillDirectory_ = spillDirectory_;
+      if (shard.spillDirectory_.empty())
+        shard.generatePrimes();
+      else
+        shard.generatePrimesOutOfCore();
+
+      // The shard may have used fewer variables, which are leading 0s here, then the shard's prefix goes in front
+      for (auto &prime : shard.primeImplicants_) {
+        CubeRecord record = CubeFile::toRecord(prime.getBitstring());
+        record.cube.value |= (uint64_t) k << suffix;
+        out.append(record);
       }
     }
+    out.map();
+    return out.good();
+  });
+  shards.clear();
+
+  // Merge the last prefix variable first, each level halving the number of shards
+  for (int level = 1; level <= prefix && succeeded; level++) {
+    int stride = 1 << (level - 1);
+    uint64_t bit = (uint64_t) 1 << (suffix + level - 1);
+
+    succeeded = runWorkers(1 << (prefix - level), [&](int pair) {
+      int k = pair * 2 * stride;
+      CubeFile primes0(shardPath(level - 1, k), true);
+      CubeFile primes1(shardPath(level - 1, k + stride), true);
+      CubeFile out(shardPath(level, k));
+      return mergeShards(primes0, primes1, bit, out);
+    });
+
+    for (int k = 0; k < (1 << prefix); k += stride) {
+      unlink(shardPath(level - 1, k).c_str());
+    }
+  }
+
+  if (succeeded) {
+    CubeFile in(shardPath(prefix, 0), true);
+    in.map();
+    for (size_t i = 0; i < in.size(); i++) {
+      primeImplicants_.push_back(CubeFile::toImplicant(in[i], numVariables_));
+    }
+    succeeded = in.good();
+  }
+  removeDirectory(dir);
+
+  if (!succeeded) {
+    std::cerr << "A shard worker failed, generating primes in this process..." << endl;
+    primeImplicants_.clear();
+    fillTable();
+    generatePrimes();
+  }
+}
+
+/**
+ * Merges the primes of two shards that only differ in one variable into the primes of both together
+ * These are the primes of each shard plus the product of every pair of primes across the two (with the variable
+ * dropped), keeping only the cubes not contained in some other cube
+ * Kept products are indexed by their dashes, so checking whether a cube is contained in one costs a lookup per
+ * distinct set of dashes instead of a comparison per product
+ *
+ * @param primes0 The primes of the shard with the variable 0
+ * @param primes1 The primes of the shard with the variable 1
+ * @param bit The variable's bit in a CubeRecord
+ * @param out Where to write the merged primes
+ * @return false if one of the files failed
+ */
+bool LogicSimplifier::mergeShards(CubeFile &primes0, CubeFile &primes1, uint64_t bit, CubeFile &out) {
+  primes0.map();
+  primes1.map();
+  if (!primes0.good() || !primes1.good()) return false;
+
+  // products[dashes] holds the values of the kept products with those dashes
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> products;
+  auto contained = [&](uint64_t value, uint64_t dashes) {
+    for (auto &bucket : products) {
+      if ((dashes & ~bucket.first) == 0 && bucket.second.count(value & ~bucket.first) > 0) return true;
+    }
+    return false;
+  };
+
+  // Products are dropped as soon as an earlier one contains them
+  for (size_t i = 0; i < primes0.size(); i++) {
+    for (size_t j = 0; j < primes1.size(); j++) {
+      Cube &c0 = primes0[i].cube, &c1 = primes1[j].cube;
+
+      // The product is empty if they contradict each other anywhere besides bit
+      uint64_t cares = ~c0.dashes & ~c1.dashes & ~bit;
+      if ((c0.value ^ c1.value) & cares) continue;
+
+      uint64_t dashes = (c0.dashes & c1.dashes) | bit;
+      uint64_t value = (c0.value | c1.value) & ~dashes;
+      if (!contained(value, dashes)) products[dashes].insert(value);
+    }
+  }
+
+  // A product kept early may still be contained in a later, larger one, so go again from the largest down
+  vector<uint64_t> masks;
+  for (auto &bucket : products) {
+    masks.push_back(bucket.first);
+  }
+  std::sort(masks.begin(), masks.end(), [](uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a) > __builtin_popcountll(b);
+  });
+
+  auto candidates = std::move(products);
+  products.clear();
+  for (uint64_t dashes : masks) {
+    for (uint64_t value : candidates[dashes]) {
+      if (!contained(value, dashes)) {
+        products[dashes].insert(value);
+        out.append({{value, dashes}, 0, 0});
+      }
+    }
+    candidates.erase(dashes);
+  }
+
+  // Neither shard's primes contain the other's or a product, since those differ from them in bit
+  for (CubeFile *primes : {&primes0, &primes1}) {
+    for (size_t i = 0; i < primes->size(); i++) {
+      Cube &cube = (*primes)[i].cube;
+      if (!contained(cube.value, cube.dashes)) out.append({cube, 0, 0});
+    }
+  }
+
+  out.map();
+  return out.good();
+}
+
+/**
+ * Finds the primes as a ZDD instead of with the ones table, then covers the minterms by querying it
+ * Essential primes are found by counting the primes covering each minterm in the ZDD, without listing them
+ * The primes covering the minterms left after that are listed one minterm at a time and reduced and covered as an
+ * ordinary prime table by reduceToCyclicCore() and coverComponents(), so that part of the chart is held explicitly
+ */
+void LogicSimplifier::coverImplicitPrimes() {
+  // The ZDD works on the same bitstrings as the ones table, it isn't needed
+  table_.clear();
+
+  DecisionDiagram diagram(numVariables_);
+  int primes = diagram.zddPrimes(diagram.bddFromMinterms(dontCares_));
+  diagram.clearCaches();
+
+  std::set<int> uncovered(minterms_.begin(), minterms_.end());
+
+  // Essential primes: the only prime covering some minterm
+  for (int m : minterms_) {
+    if (uncovered.count(m) == 0 || diagram.zddCoveringCount(primes, m) != 1) continue;
+
+    Cube essential = diagram.zddCovering(primes, m)[0];
+    essentialPrimeImplicants_.insert(essential.toImplicant(numVariables_));
+    for (int covered : coveredMinterms(essential, uncovered)) {
+      uncovered.erase(covered);
+    }
+  }
+
+  // List only the primes covering a minterm that is left
+  std::set<Cube> rows;
+  for (int m : uncovered) {
+    for (auto &cube : diagram.zddCovering(primes, m)) {
+      rows.insert(cube);
+    }
+  }
+  for (auto &cube : rows) {
+    primeImplicants_.push_back(cube.toImplicant(numVariables_));
+  }
+  minterms_.assign(uncovered.begin(), uncovered.end());
+
+  setupPrimeTable();
+  reduceToCyclicCore();
+  coverComponents();
+}
+
+/**
+ * Lists the minterms in a set that a cube covers
+ * Walks whichever of the cube's minterms or the part of the set between its smallest and largest minterm is smaller
+ *
+ * @param cube The cube
+ * @param minterms The set of minterms
+ * @return The covered minterms, in increasing order
+ */
+vector<int> LogicSimplifier::coveredMinterms(const Cube &cube, const std::set<int> &minterms) {
+  vector<int> covered;
+  int dashes = cube.numDashes();
+
+  if (dashes < 31 && (1u << dashes) < minterms.size()) {
+    for (int m : cube.minterms()) {
+      if (minterms.count(m) > 0) covered.push_back(m);
+    }
+  }
+  else {
+    auto end = minterms.upper_bound((int) (cube.value | cube.dashes));
+    for (auto it = minterms.lower_bound((int) cube.value); it != end; ++it) {
+      if (cube.covers(*it)) covered.push_back(*it);
+    }
+  }
+  return covered;
+}
+
+void LogicSimplifier::setupPrimeTable() {
+  // A minterm listed twice is still one column
+  std::sort(minterms_.begin(), minterms_.end());
+  minterms_.erase(std::unique(minterms_.begin(), minterms_.end()), minterms_.end());
+
+  int numRows = primeImplicants_.size(), numCols = minterms_.size();
+  primeTable_.resize(numRows);
+  for (auto &r : primeTable_) {
+    r.assign((numCols + 63) / 64, 0);
+  }
+  primeTableColumns_.resize(numCols);
+  for (auto &c : primeTableColumns_) {
+    c.assign((numRows + 63) / 64, 0);
+  }
+  rowCounts_.assign(numRows, 0);
+  colCounts_.assign(numCols, 0);
+  rowRemoved_.assign(numRows, false);
+  colRemoved_.assign(numCols, false);
+  primeSizes_.assign(numRows, 0);
+  mintermsLeft_ = numCols;
+
+  for (int r = 0; r < numRows; r++) {
+    vector<int> parents = primeImplicants_[r].getParents();
+    primeSizes_[r] = parents.size();
+
+    // Look up the column of each parent instead of searching the parents for every minterm
+    for (int mintermNumber : parents) {
+      auto it = std::lower_bound(minterms_.begin(), minterms_.end(), mintermNumber);
+      if (it == minterms_.end() || *it != mintermNumber) continue;
+
+      int c = it - minterms_.begin();
+      if (hasBit(primeTable_[r], c)) continue;
+      setBit(primeTable_[r], c);
+      setBit(primeTableColumns_[c], r);
+      rowCounts_[r]++;
+      colCounts_[c]++;
+    }
+  }
+
+  // Every row and column has to be checked once, after that only the ones whose counts changed
+  changedRows_.clear();
+  changedColumns_.clear();
+  singleColumns_.clear();
+  rowChanged_.assign(numRows, true);
+  colChanged_.assign(numCols, true);
+  for (int r = 0; r < numRows; r++) {
+    changedRows_.push_back(r);
+  }
+  for (int c = 0; c < numCols; c++) {
+    changedColumns_.push_back(c);
+    if (colCounts_[c] == 1) singleColumns_.push_back(c);
   }
 }
 
+/**
+ * Picks the prime covering the most minterms left, removing it and the minterms it covers from the prime table
+ * Needs the prime table from setupPrimeTable(), which simplify() sets up
+ */
 void LogicSimplifier::extractCover() {
 
-  vector<int> rowCounts;
-  int count, max = 0, maxRow = -1;
+  int max = 0, maxRow = -1;
   for (int r = primeImplicants_.size() - 1; r >= 0; r--) {
-    count = 0;
-    for (int c = 0; c < minterms_.size(); c++) {
-      if (primeTable_[r][c]) count++;
-    }
-    if (count > max) {
-      max = count;
+    if (rowCounts_[r] > max) {
+      max = rowCounts_[r];
       maxRow = r;
     }
-    rowCounts.push_back(count);
   }
 
   essentialPrimeImplicants_.insert(primeImplicants_[maxRow]);
 
-  std::set<int> rowsToRemove = {maxRow};
+  vector<int> coveredColumns = bitIndices(primeTable_[maxRow]);
+  removeColumns(std::set<int>(coveredColumns.begin(), coveredColumns.end()));
+  removeRows({maxRow});
 
-  vector<int> coveredMinterms = primeImplicants_[maxRow].getParents();
+}
+
+/**
+ * Moves every prime that is the only cover of some minterm into essentialPrimeImplicants_ and removes it along with
+ * the minterms it covers from the prime table
+ * Only the columns whose count has dropped to 1 since the last call are looked at
+ *
+ * @return true if any essential primes were found
+ */
+bool LogicSimplifier::extractEssentials() {
+  vector<int> columns;
+  columns.swap(singleColumns_);
 
-  std::set<int> columnsToRemove = mintermsToIndices(coveredMinterms);
+  bool found = false;
+  for (int c : columns) {
+    if (colRemoved_[c] || colCounts_[c] != 1) continue;
 
-  removeRows(rowsToRemove);
-  removeColumns(columnsToRemove);
+    int index = bitIndices(primeTableColumns_[c])[0];
+    essentialPrimeImplicants_.insert(primeImplicants_[index]);
 
+    vector<int> coveredColumns = bitIndices(primeTable_[index]);
+    removeColumns(std::set<int>(coveredColumns.begin(), coveredColumns.end()));
+    removeRows({index});
+    found = true;
+  }
+  return found;
 }
 
-void LogicSimplifier::extractEssentials() {
-  setupPrimeTable();
+/**
+ * Removes every row whose minterms are all covered by some other row
+ * Rows covering the same minterms are tie broken in favor of the larger implicant, then the lower index
+ * A row can only become dominated by losing minterms, so only the rows that lost some since the last call are checked
+ *
+ * @return true if any rows were removed
+ */
+bool LogicSimplifier::removeDominatedRows() {
+  vector<int> rows;
+  rows.swap(changedRows_);
+
+  bool removed = false;
+  for (int r1 : rows) {
+    rowChanged_[r1] = false;
+    if (rowRemoved_[r1]) continue;
+
+    // A row that covers nothing is dominated by any other row
+    if (rowCounts_[r1] == 0) {
+      removeRows({r1});
+      removed = true;
+      continue;
+    }
 
-  std::set<int> columnsToRemove;
-  vector<int> mintermsToRemove;
-  std::set<int> rowsToRemove;
+    // Any row dominating r1 also covers r1's least covered minterm
+    int least = -1;
+    for (int c : bitIndices(primeTable_[r1])) {
+      if (least < 0 || colCounts_[c] < colCounts_[least]) least = c;
+    }
+
+    for (int r2 : bitIndices(primeTableColumns_[least])) {
+      // r2 can only cover everything r1 does if it covers at least as many minterms
+      if (r2 == r1 || rowRemoved_[r2] || rowCounts_[r2] < rowCounts_[r1]) continue;
+      if (!isSubset(primeTable_[r1], primeTable_[r2])) continue;
+
+      // Covering the same minterms, r2 may be the one to go
+      if (rowCounts_[r2] == rowCounts_[r1]) {
+        int size1 = primeSizes_[r1], size2 = primeSizes_[r2];
+        if (size1 > size2 || (size1 == size2 && r1 < r2)) {
+          removeRows({r2});
+          removed = true;
+          continue;
+        }
+      }
+
+      removeRows({r1});
+      removed = true;
+      break;
+    }
+  }
+  return removed;
+}
+
+/**
+ * Removes every column that is covered by all the rows of some other column, since covering that other column will
+ * cover it as well
+ * Columns covered by the same rows are tie broken in favor of the lower index
+ * A column can only come to be dominated by one that lost rows, so only those since the last call are checked
+ *
+ * @return true if any columns were removed
+ */
+bool LogicSimplifier::removeDominatingColumns() {
+  vector<int> columns;
+  columns.swap(changedColumns_);
+
+  bool removed = false;
+  for (int c2 : columns) {
+    colChanged_[c2] = false;
+    if (colRemoved_[c2] || colCounts_[c2] == 0) continue;
+
+    // Any column covered by every row of c2 is in particular covered by c2's row covering the fewest minterms
+    int least = -1;
+    for (int r : bitIndices(primeTableColumns_[c2])) {
+      if (least < 0 || rowCounts_[r] < rowCounts_[least]) least = r;
+    }
 
-  int count, index = -1;
-  for (int c = 0; c < primeTable_[0].size(); c++) {
-    count = 0;
+    for (int c1 : bitIndices(primeTable_[least])) {
+      // c1 can only be covered by every row of c2 if it is covered by at least as many rows
+      if (c1 == c2 || colRemoved_[c1] || colCounts_[c1] < colCounts_[c2]) continue;
+      if (!isSubset(primeTableColumns_[c2], primeTableColumns_[c1])) continue;
 
-    for (int r = 0; r < primeTable_.size(); r++) {
-      if (primeTable_[r][c]) {
-        count++;
-        index = r;
+      // Covered by the same rows, c2 may be the one to go
+      if (colCounts_[c1] == colCounts_[c2] && c1 < c2) {
+        removeColumns({c2});
+        removed = true;
+        break;
       }
 
+      removeColumns({c1});
+      removed = true;
     }
+  }
+  return removed;
+}
 
-    if (count == 1 && index > -1) {
+/**
+ * Repeatedly extracts essential primes and removes dominated rows and dominating columns from the prime table until
+ * none of them change it anymore, leaving only the cyclic core for extractCover() to work on
+ */
+void LogicSimplifier::reduceToCyclicCore() {
+  bool changed = true;
+  while (changed && mintermsLeft_ > 0) {
+    changed = extractEssentials();
+    changed |= removeDominatedRows();
+    changed |= removeDominatingColumns();
+  }
+}
 
-      rowsToRemove.insert(index);
+/**
+ * Greedily picks the prime covering the most minterms and reduces the table again until every minterm is covered
+ * Each pick only changes the rows and columns it touches, so reducing again only rechecks those
+ */
+void LogicSimplifier::coverCyclicCore() {
+  while (mintermsLeft_ > 0) {
+    extractCover();
+    reduceToCyclicCore();
+  }
+}
 
-      Implicant essentialPrime = primeImplicants_[index];
-      essentialPrimeImplicants_.insert(essentialPrime);
+/**
+ * Splits the prime table into groups of rows and columns that share no coverage with each other
+ *
+ * @return For each group, the row indices of its primes and the column indices of its minterms
+ */
+vector<std::pair<vector<int>, vector<int>>> LogicSimplifier::findComponents() {
+  vector<std::pair<vector<int>, vector<int>>> components;
+  vector<bool> rowVisited(primeTable_.size(), false);
+  vector<bool> colVisited(minterms_.size(), false);
+
+  for (int start = 0; start < minterms_.size(); start++) {
+    if (colVisited[start] || colRemoved_[start]) continue;
+
+    // Walk from column to rows to columns until the whole group has been reached
+    vector<int> rows, cols = {start};
+    colVisited[start] = true;
+    for (int i = 0; i < cols.size(); i++) {
+      for (int r : bitIndices(primeTableColumns_[cols[i]])) {
+        if (rowVisited[r]) continue;
+        rowVisited[r] = true;
+        rows.push_back(r);
+
+        for (int c2 : bitIndices(primeTable_[r])) {
+          if (!colVisited[c2]) {
+            colVisited[c2] = true;
+            cols.push_back(c2);
+          }
+        }
+      }
+    }
 
-      vector<int> parents = essentialPrime.getParents();
+    components.push_back({rows, cols});
+  }
+  return components;
+}
+
+/**
+ * Covers what is left of the prime table one independent group of rows and columns at a time, merging the chosen
+ * primes into essentialPrimeImplicants_
+ * Large tables spread the groups over several threads, small ones cover them one after another on this thread
+ */
+void LogicSimplifier::coverComponents() {
+  vector<std::pair<vector<int>, vector<int>>> components = findComponents();
 
-      mintermsToRemove.insert(mintermsToRemove.end(), parents.begin(), parents.end());
+  // A single group is the whole table, so cover it in place
+  if (components.size() <= 1) {
+    coverCyclicCore();
+    return;
+  }
+
+  vector<std::set<Implicant>> covers(components.size());
+
+  // Copies group k into its own simplifier so threads never share a table, the simplifier being reused for every group
+  auto coverComponent = [&](LogicSimplifier &component, int k) {
+    component.primeImplicants_.clear();
+    component.minterms_.clear();
+    component.essentialPrimeImplicants_.clear();
+    for (int r : components[k].first)
+      component.primeImplicants_.push_back(primeImplicants_[r]);
+    for (int c : components[k].second)
+      component.minterms_.push_back(minterms_[c]);
+
+    component.setupPrimeTable();
+    component.coverCyclicCore();
+    covers[k] = component.essentialPrimeImplicants_;
+  };
+
+  int numThreads = threads_ > 0 ? threads_ : std::max(1, (int) std::thread::hardware_concurrency());
+  numThreads = std::min(numThreads, (int) components.size());
+
+  long cells = 0;
+  for (auto &component : components) {
+    cells += (long) component.first.size() * component.second.size();
+  }
 
+  if (numThreads <= 1 || cells < PARALLEL_COVER_CELLS) {
+    // Too little work to pay for starting threads
+    LogicSimplifier component;
+    for (int k = 0; k < components.size(); k++) {
+      coverComponent(component, k);
     }
+  }
+  else {
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+      LogicSimplifier component;
+      for (int k = next++; k < components.size(); k = next++) {
+        coverComponent(component, k);
+      }
+    };
 
+    vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+      threads.emplace_back(worker);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
   }
 
-  columnsToRemove = mintermsToIndices(mintermsToRemove);
-  removeColumns(columnsToRemove);
-  removeRows(rowsToRemove);
+  for (auto &cover : covers) {
+    essentialPrimeImplicants_.insert(cover.begin(), cover.end());
+  }
 
+  // Every minterm has been covered by one of the groups
+  clearPrimeTable();
 }
 
 void LogicSimplifier::essentialsToEquation() {
+  // No minterms, the function is always 0
+  if (essentialPrimeImplicants_.empty()) {
+    equation_ += "0";
+    return;
+  }
+
+  // A prime with no literals (all dashes) covers everything, so it is the only prime and the function is always 1
+  if (implicantToLiterals(*essentialPrimeImplicants_.begin()).empty()) {
+    equation_ += "1";
+    return;
+  }
+
   auto it = essentialPrimeImplicants_.begin();
   equation_ += (implicantToLiterals(*it));
   it++;
@@ -258,9 +1054,9 @@ void LogicSimplifier::essentialsToEquation() {
 }
 
 
-vector<Implicant> LogicSimplifier::compare(vector<Implicant> &vec1, vector<Implicant> &vec2) {
+void LogicSimplifier::compare(vector<Implicant> &vec1, vector<Implicant> &vec2, vector<Implicant> &newVec) {
   char delim = '-';
-  vector<Implicant> newVec;
+  newVec.clear();
 
   for (int i = 0; i < vec1.size(); i++) {
     for (int j = 0; j < vec2.size(); j++) {
@@ -306,31 +1102,115 @@ vector<Implicant> LogicSimplifier::compare(vector<Implicant> &vec1, vector<Impli
       }
     }
   }
+}
 
-  return newVec;
+/**
+ * Combines every pair of cubes from two neighbouring groups that differ in exactly one bit, writing the results to
+ * out and marking the cubes that were combined as included
+ * Both groups must be mapped and sorted, so only runs with the same dashes need to be compared
+ *
+ * @param group1 The group with fewer ones
+ * @param group2 The group with one more one
+ * @param out The group of the next level to write to
+ */
+void LogicSimplifier::compare(CubeFile &group1, CubeFile &group2, CubeFile &out) {
+  size_t i = 0, j = 0;
+  while (i < group1.size() && j < group2.size()) {
+    uint64_t dashes = group1[i].cube.dashes;
+    if (dashes < group2[j].cube.dashes) {
+      i++;
+      continue;
+    }
+    if (dashes > group2[j].cube.dashes) {
+      j++;
+      continue;
+    }
+
+    size_t iEnd = i, jEnd = j;
+    while (iEnd < group1.size() && group1[iEnd].cube.dashes == dashes) iEnd++;
+    while (jEnd < group2.size() && group2[jEnd].cube.dashes == dashes) jEnd++;
+
+    for (size_t x = i; x < iEnd; x++) {
+      for (size_t y = j; y < jEnd; y++) {
+        uint64_t difference = group1[x].cube.value ^ group2[y].cube.value;
+
+        // Exactly one bit set means they differ in exactly one place
+        if (difference != 0 && (difference & (difference - 1)) == 0) {
+          group1[x].included = 1;
+          group2[y].included = 1;
+          out.append({{group1[x].cube.value, dashes | difference}, 0, 0});
+        }
+      }
+    }
+
+    i = iEnd;
+    j = jEnd;
+  }
 }
 
+/**
+ * Takes rows out of the prime table, updating the counts of the columns they covered
+ */
 void LogicSimplifier::removeRows(std::set<int> rows) {
-  for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
-    int row = *it;
-    primeTable_.erase(primeTable_.begin() + row);
-    primeImplicants_.erase(primeImplicants_.begin() + row);
+  for (int row : rows) {
+    if (rowRemoved_[row]) continue;
+
+    for (int c : bitIndices(primeTable_[row])) {
+      clearBit(primeTableColumns_[c], row);
+      colCounts_[c]--;
+      if (colCounts_[c] == 1) singleColumns_.push_back(c);
+      if (!colChanged_[c]) {
+        colChanged_[c] = true;
+        changedColumns_.push_back(c);
+      }
+    }
+
+    std::fill(primeTable_[row].begin(), primeTable_[row].end(), 0);
+    rowCounts_[row] = 0;
+    rowRemoved_[row] = true;
   }
 }
 
+/**
+ * Takes columns out of the prime table, updating the counts of the rows that covered them
+ */
 void LogicSimplifier::removeColumns(std::set<int> cols) {
-
-  for (auto it = cols.rbegin(); it != cols.rend(); ++it) {
-    int colToErase = *it;
-    minterms_.erase(minterms_.begin() + colToErase);
-
-    for (int r = 0; r < primeTable_.size(); r++) {
-      primeTable_[r].erase(primeTable_[r].begin() + colToErase);
-
+  for (int col : cols) {
+    if (colRemoved_[col]) continue;
+
+    for (int r : bitIndices(primeTableColumns_[col])) {
+      clearBit(primeTable_[r], col);
+      rowCounts_[r]--;
+      if (!rowChanged_[r]) {
+        rowChanged_[r] = true;
+        changedRows_.push_back(r);
+      }
     }
 
+    std::fill(primeTableColumns_[col].begin(), primeTableColumns_[col].end(), 0);
+    colCounts_[col] = 0;
+    colRemoved_[col] = true;
+    mintermsLeft_--;
   }
+}
 
+/**
+ * Empties the prime table once every minterm in it has been covered
+ */
+void LogicSimplifier::clearPrimeTable() {
+  primeTable_.clear();
+  primeTableColumns_.clear();
+  primeImplicants_.clear();
+  minterms_.clear();
+  rowCounts_.clear();
+  colCounts_.clear();
+  rowRemoved_.clear();
+  colRemoved_.clear();
+  primeSizes_.clear();
+  changedRows_.clear();
+  changedColumns_.clear();
+  singleColumns_.clear();
+  mintermsLeft_ = 0;
 }
 
 
@@ -410,18 +1290,6 @@ string LogicSimplifier::implicantToLiterals(Implicant i) {
   return literals;
 }
 
-std::set<int> LogicSimplifier::mintermsToIndices(vector<int> minterms) {
-  std::set<int> indices;
-  for (int x = 0; x < minterms.size(); x++) {
-
-    for (int i = 0; i < minterms_.size(); i++) {
-      if (minterms[x] == minterms_[i]) {
-        indices.insert(i);
-      }
-    }
-  }
-  return indices;
-}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -436,6 +1304,48 @@ std::set<int> LogicSimplifier::mintermsToIndices(vector<int> minterms) {
 
 
 ///     SETTERS     ////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Keeps the levels of the ones table in memory-mapped files under the given directory while simplifying, which is
+ * slower but lets functions whose table doesn't fit in memory finish
+ *
+ * @param directory An existing writable directory, or "" to keep the table in memory
+ */
+void LogicSimplifier::setSpillDirectory(string directory) {
+  spillDirectory_ = directory;
+}
+
+/**
+ * Finds the primes implicitly as a ZDD instead of with the ones table, for functions with too many primes to list
+ * Only the essential primes are found on the ZDD, the primes covering the minterms left after them are still listed
+ * in an explicit prime table to be covered
+ * Takes priority over setSpillDirectory()
+ *
+ * @param implicit Whether to use the ZDD
+ */
+void LogicSimplifier::setImplicitPrimes(bool implicit) {
+  implicitPrimes_ = implicit;
+}
+
+/**
+ * Generates primes in one worker process per value of the first few variables, merging their results afterwards, so
+ * a single function can be spread over several processes
+ *
+ * @param variables How many leading variables to split on (2^variables shards), or 0 to use this process only
+ * @param directory An existing writable directory for the workers' files
+ */
+void LogicSimplifier::setShards(int variables, string directory) {
+  shardVariables_ = variables;
+  shardDirectory_ = directory;
+}
+
+/**
+ * Limits how many threads are used to cover independent parts of the prime table
+ *
+ * @param threads The most threads to use, or 0 to use one per hardware thread
+ */
+void LogicSimplifier::setThreads(int threads) {
+  threads_ = threads;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -456,8 +1366,17 @@ vector<vector<Implicant>> LogicSimplifier::getTable() {
   return table_;
 }
 
+/**
+ * @return The prime table, with the rows and columns already removed from it left empty
+ */
 vector<vector<bool>> LogicSimplifier::getPrimeTable() {
-  return primeTable_;
+  vector<vector<bool>> table(primeTable_.size(), vector<bool>(minterms_.size(), false));
+  for (int r = 0; r < primeTable_.size(); r++) {
+    for (int c : bitIndices(primeTable_[r])) {
+      table[r][c] = true;
+    }
+  }
+  return table;
 }
 
 std::set<Implicant> LogicSimplifier::getEssentialPrimes() {
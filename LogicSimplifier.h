@@ -5,7 +5,10 @@
 #ifndef QUINE_MCCLUSKEY_ALGORITHM_LOGICSIMPLIFIER_H
 #define QUINE_MCCLUSKEY_ALGORITHM_LOGICSIMPLIFIER_H
 
+#include <functional>
 #include "Implicant.h"
+#include "CubeFile.h"
+#include "DecisionDiagram.h"
 
 class LogicSimplifier {
  public:
@@ -25,23 +28,53 @@ class LogicSimplifier {
   void display(vector<int>);
   void display(std::set<int>);
   std::set<Implicant> simplify();
+  void reset(vector<int>, vector<int>);
+
+  void setSpillDirectory(string);
+  void setImplicitPrimes(bool);
+  void setShards(int, string);
+  void setThreads(int);
 
   void displayEssentialPrimes();
 
-  void extractEssentials();
   void extractCover();
 
   string getEquation();
 
  private:
   vector<vector<Implicant>> table_;
+  // Spare rows of the ones table, which the next level is compared into so their memory is reused
+  vector<vector<Implicant>> nextTable_;
   vector<Implicant> implicants_;
   vector<Implicant> primeImplicants_;
 
   // row index = index in primeImplicants_
   // col index = index in minterms_
-  // primeTable_[r][c] = ???
-  vector<vector<bool>> primeTable_;
+  // primeTable_[r] = bitset of the columns prime r covers
+  // primeTableColumns_[c] = bitset of the rows covering minterm c
+  // removed rows and columns are emptied and marked in rowRemoved_ / colRemoved_, so indices never shift
+  vector<vector<uint64_t>> primeTable_;
+  vector<vector<uint64_t>> primeTableColumns_;
+  vector<bool> rowRemoved_;
+  vector<bool> colRemoved_;
+  int mintermsLeft_ = 0;
+
+  // rowCounts_[r] = number of minterms left in primeTable_ row r
+  // colCounts_[c] = number of primes left in primeTable_ column c
+  // kept up to date by removeRows() and removeColumns()
+  vector<int> rowCounts_;
+  vector<int> colCounts_;
+
+  // primeSizes_[r] = number of minterms (dont cares included) prime r covers, for breaking ties between rows
+  vector<int> primeSizes_;
+
+  // rows and columns whose counts changed since the dominance checks last looked at them, and columns whose count
+  // dropped to 1 since extractEssentials() last looked
+  vector<int> changedRows_;
+  vector<int> changedColumns_;
+  vector<bool> rowChanged_;
+  vector<bool> colChanged_;
+  vector<int> singleColumns_;
 
   std::set<Implicant> essentialPrimeImplicants_;
 
@@ -52,16 +85,46 @@ class LogicSimplifier {
   string literals_;
   string equation_ = "F(";
 
+  // when not empty, levels of the ones table are kept in memory-mapped files under this directory
+  string spillDirectory_;
+
+  // when true, primes are kept in a ZDD instead of primeImplicants_ and covered straight from it
+  bool implicitPrimes_ = false;
+
+  // when above 0, primes are generated in a separate process for each value of this many leading variables, with
+  // the processes' cubes written under shardDirectory_ and merged afterwards
+  int shardVariables_ = 0;
+  string shardDirectory_;
+
+  // most threads coverComponents() may use, 0 for one per hardware thread
+  int threads_ = 0;
+
   void essentialsToEquation();
   string implicantToLiterals(Implicant i);
 
-  std::set<int> mintermsToIndices(vector<int>);
   void removeRows(std::set<int>);
   void removeColumns(std::set<int>);
   void setupPrimeTable();
-  vector<Implicant> compare(vector<Implicant> &, vector<Implicant> &);
+  void clearPrimeTable();
+  bool extractEssentials();
+  void reduceToCyclicCore();
+  void coverComponents();
+  bool removeDominatedRows();
+  bool removeDominatingColumns();
+  void coverCyclicCore();
+  vector<std::pair<vector<int>, vector<int>>> findComponents();
+  void generatePrimes();
+  void generatePrimesOutOfCore();
+  void generatePrimesSharded();
+  bool mergeShards(CubeFile &, CubeFile &, uint64_t, CubeFile &);
+  bool runWorkers(int, const std::function<bool(int)> &);
+  void compare(vector<Implicant> &, vector<Implicant> &, vector<Implicant> &);
+  void compare(CubeFile &, CubeFile &, CubeFile &);
+  void coverImplicitPrimes();
+  vector<int> coveredMinterms(const Cube &, const std::set<int> &);
   void setup();
   void fillTable();
+  void resizeTable(int);
   int countOnes(string);
   string decimalToBitstring(int, int);
   int numVariables(vector<int>);
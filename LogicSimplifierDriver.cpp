@@ -34,7 +34,53 @@ void displayPrimeTable(vector<vector<bool>> t) {
   cout << endl;
 }
 
-int main() {
+void displayUsage() {
+  std::cerr << "Usage: LogicSimplifier [--minterms LIST] [--dont-cares LIST] [--shards N DIR]" << endl
+            << "  --minterms LIST    comma separated minterms to simplify, such as 1,3,4,5" << endl
+            << "  --dont-cares LIST  comma separated dont cares, such as 2" << endl
+            << "  --shards N DIR     generate primes in 2^N worker processes, keeping their files in DIR" << endl;
+}
+
+/**
+ * Parses a number from the command line
+ *
+ * @param text The argument to parse
+ * @param value Where to store the number
+ * @return false if text isn't a whole number
+ */
+bool parseNumber(const string &text, int &value) {
+  size_t end;
+  try {
+    value = std::stoi(text, &end);
+  }
+  catch (const std::logic_error &) {
+    return false;
+  }
+  return end == text.size();
+}
+
+/**
+ * Parses a comma separated list of numbers from the command line
+ *
+ * @param text The argument to parse
+ * @param values Where to add the numbers
+ * @return false if any entry isn't a whole number
+ */
+bool parseList(const string &text, vector<int> &values) {
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t comma = text.find(',', start);
+    if (comma == string::npos) comma = text.size();
+
+    int value;
+    if (!parseNumber(text.substr(start, comma - start), value) || value < 0) return false;
+    values.push_back(value);
+    start = comma + 1;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
 
   vector<int> minterms_3{0, 1, 2, 7};
 
@@ -51,7 +97,55 @@ int main() {
        68, 69, 72, 73, 77, 79, 80, 81, 82, 83, 84, 86, 87, 91, 92, 93, 94, 95, 96, 98, 99, 100, 102, 107, 110, 117, 119,
        123, 124, 125, 127};
 
-  LogicSimplifier ls({1, 3, 4, 5}, {2});
+  // Without --minterms, simplify a small example
+  vector<int> minterms, dontCares;
+  bool mintermsGiven = false;
+  int shardVariables = 0;
+  string shardDirectory;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--minterms" && i + 1 < argc) {
+      if (!parseList(argv[++i], minterms)) {
+        std::cerr << "Invalid minterms " << argv[i] << endl;
+        displayUsage();
+        return 1;
+      }
+      mintermsGiven = true;
+    }
+    else if (arg == "--dont-cares" && i + 1 < argc) {
+      if (!parseList(argv[++i], dontCares)) {
+        std::cerr << "Invalid dont cares " << argv[i] << endl;
+        displayUsage();
+        return 1;
+      }
+    }
+    else if (arg == "--shards" && i + 2 < argc) {
+      if (!parseNumber(argv[i + 1], shardVariables) || shardVariables < 0) {
+        std::cerr << "Invalid number of shard variables " << argv[i + 1] << endl;
+        displayUsage();
+        return 1;
+      }
+      shardDirectory = argv[i + 2];
+      i += 2;
+    }
+    else {
+      if (arg == "--minterms" || arg == "--dont-cares" || arg == "--shards")
+        std::cerr << "Missing value for " << arg << endl;
+      else
+        std::cerr << "Unknown argument " << arg << endl;
+      displayUsage();
+      return 1;
+    }
+  }
+
+  if (!mintermsGiven) {
+    minterms = {1, 3, 4, 5};
+    dontCares = {2};
+  }
+
+  LogicSimplifier ls(minterms, dontCares);
+  if (shardVariables > 0) ls.setShards(shardVariables, shardDirectory);
 
   auto start = std::chrono::high_resolution_clock::now();
 